@@ -0,0 +1,267 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Boot a Darkmatter kernel under Android-x86 and record how long it takes
+# to load and decompress (QEMU only), unpack the initramfs and reach init,
+# zygote and the launcher, plus binder round-trip latency, app cold-start
+# time and frame pacing. One JSON report per branch.
+#
+# QEMU/KVM:   boot-bench.sh -b serenade -k bzImage -i initrd.img -d android.img
+# Bare metal: boot-bench.sh -b serenade -t device [-s <adb serial>]
+#
+# In device mode the target must already be running the kernel under test
+# with adb reachable; every run reboots it with "adb reboot".
+
+. "$(dirname "$0")/lib.sh"
+
+usage() {
+	cat >&2 <<EOF
+usage: $(basename "$0") -b <branch> [options]
+  -b <branch>     branch name recorded in the report (e.g. crimson-zen)
+  -t qemu|device  where to boot (default: qemu)
+  -k <bzImage>    kernel image (qemu)
+  -i <initrd>     Android-x86 initrd (qemu)
+  -d <disk>       Android-x86 disk image, never written to (qemu)
+  -c <cmdline>    extra kernel command line (qemu)
+  -s <serial>     adb serial of the target (device)
+  -n <runs>       number of boots (default: 5)
+  -a <component>  activity used for cold start and frame pacing
+                  (default: com.android.settings/.Settings)
+  -o <dir>        report directory (default: results)
+EOF
+	exit 1
+}
+
+BRANCH=
+MODE=qemu
+KERNEL=
+INITRD=
+DISK=
+CMDLINE=
+SERIAL=
+RUNS=5
+COMPONENT=com.android.settings/.Settings
+OUTDIR=results
+
+QEMU=${QEMU:-qemu-system-x86_64}
+QEMU_SMP=${QEMU_SMP:-4}
+QEMU_MEM=${QEMU_MEM:-4096}
+ADB_PORT=${ADB_PORT:-5555}
+SETTLE=${SETTLE:-30}
+
+while getopts b:t:k:i:d:c:s:n:a:o:h opt; do
+	case $opt in
+	b) BRANCH=$OPTARG ;;
+	t) MODE=$OPTARG ;;
+	k) KERNEL=$OPTARG ;;
+	i) INITRD=$OPTARG ;;
+	d) DISK=$OPTARG ;;
+	c) CMDLINE=$OPTARG ;;
+	s) SERIAL=$OPTARG ;;
+	n) RUNS=$OPTARG ;;
+	a) COMPONENT=$OPTARG ;;
+	o) OUTDIR=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+
+[ -n "$BRANCH" ] || usage
+PKG=${COMPONENT%%/*}
+
+case $MODE in
+qemu)
+	[ -f "$KERNEL" ] && [ -f "$INITRD" ] && [ -f "$DISK" ] ||
+		die "qemu mode needs -k, -i and -d"
+	ADB="adb -s localhost:$ADB_PORT"
+	;;
+device)
+	[ -n "$SERIAL" ] && ADB="adb -s $SERIAL"
+	;;
+*)
+	usage
+	;;
+esac
+
+WORK=$(mktemp -d)
+QEMU_PID=
+QEMU_START=
+trap 'stop_qemu; rm -rf "$WORK"' EXIT INT TERM
+
+start_qemu() {
+	# snapshot=on keeps the disk image pristine, so every boot and every
+	# branch starts from the same userspace state.
+	$QEMU -enable-kvm -cpu host -smp "$QEMU_SMP" -m "$QEMU_MEM" \
+		-kernel "$KERNEL" -initrd "$INITRD" \
+		-append "root=/dev/ram0 SRC=/ console=ttyS0 $CMDLINE" \
+		-drive file="$DISK",if=virtio,format=raw,snapshot=on \
+		-netdev user,id=net0,hostfwd=tcp::"$ADB_PORT"-:5555 \
+		-device virtio-net-pci,netdev=net0 \
+		-vga virtio -display none \
+		-serial file:"$WORK/serial.log" &
+	QEMU_PID=$!
+	QEMU_START=$(now_ms)
+
+	until adb connect "localhost:$ADB_PORT" | grep -q '^connected'; do
+		kill -0 "$QEMU_PID" 2>/dev/null || die "qemu exited early"
+		sleep 1
+	done
+}
+
+stop_qemu() {
+	[ -n "$QEMU_PID" ] || return 0
+	adb disconnect "localhost:$ADB_PORT" >/dev/null 2>&1
+	kill "$QEMU_PID" 2>/dev/null
+	wait "$QEMU_PID" 2>/dev/null
+	QEMU_PID=
+}
+
+boot_target() {
+	if [ "$MODE" = qemu ]; then
+		stop_qemu
+		start_qemu
+	else
+		$ADB reboot
+		sleep 5
+	fi
+	wait_boot_completed 600 || die "target did not finish booting"
+	LOADER_MS=$(measure_loader)
+	$ADB root >/dev/null 2>&1
+	$ADB wait-for-device
+	# Let boot-time jobs (dexopt, media scan) settle before measuring.
+	sleep "$SETTLE"
+}
+
+# Firmware, kernel load and decompression time in ms: from starting QEMU
+# to the kernel's clock starting, which is "now" minus the guest uptime.
+# Bare metal has no equivalent starting point, so only QEMU reports it.
+measure_loader() {
+	[ -n "$QEMU_START" ] || return
+	up=$(dev cat /proc/uptime | awk '{ printf "%d\n", $1 * 1000 }')
+	echo $(($(now_ms) - up - QEMU_START))
+}
+
+# Time spent unpacking the initramfs, in ms. Since 5.13 this runs
+# asynchronously (initramfs_async=1) alongside the other initcalls.
+measure_initramfs() {
+	dev dmesg | awk -F'[][]' '
+		/Trying to unpack rootfs image as initramfs/ { s = $2 }
+		/Freeing initrd memory/ && s != "" { printf "%d\n", ($2 - s) * 1000; exit }'
+}
+
+# Kernel timestamp, in ms, when the first userspace init was started.
+measure_init() {
+	dev dmesg | awk -F'[][]' '
+		/Run .* as init process/ { run = $2; exit }
+		/Freeing unused kernel.*memory/ { freeing = $2 }
+		END {
+			t = run != "" ? run : freeing
+			if (t != "") printf "%d\n", t * 1000
+		}'
+}
+
+measure_zygote() {
+	ns=$(dev getprop ro.boottime.zygote)
+	if [ -n "$ns" ]; then
+		echo $((ns / 1000000))
+	else
+		dev logcat -b events -d |
+			awk '/boot_progress_start/ { print $NF; exit }'
+	fi
+}
+
+measure_launcher() {
+	dev logcat -b events -d |
+		awk '/boot_progress_enable_screen/ { print $NF; exit }'
+}
+
+# Average binder round trip in microseconds, using the AOSP
+# binderThroughputTest when the image ships it.
+measure_binder() {
+	for bin in /data/nativetest64/binderThroughputTest/binderThroughputTest \
+		   /data/nativetest/binderThroughputTest/binderThroughputTest; do
+		[ "$(dev "[ -x $bin ] && echo y")" = y ] || continue
+		dev "$bin" -w 2 -i 10000 |
+			sed -n 's/.*average:\([0-9.]*\)ms.*/\1/p' |
+			awk 'NR == 1 { printf "%.1f\n", $1 * 1000 }'
+		return
+	done
+}
+
+measure_cold_start() {
+	dev am force-stop "$PKG"
+	dev "sync; echo 3 > /proc/sys/vm/drop_caches"
+	sleep 2
+	dev am start -W -n "$COMPONENT" |
+		awk -F': *' '/^TotalTime/ { print $2 }'
+}
+
+# Scroll the cold-started activity and dump its frame statistics to
+# $WORK/gfxinfo.
+measure_frames() {
+	size=$(dev wm size | awk '{ print $NF }' | tail -n 1)
+	w=${size%x*}
+	h=${size#*x}
+	dev dumpsys gfxinfo "$PKG" reset >/dev/null
+	for i in 1 2 3 4 5 6 7 8 9 10; do
+		dev input swipe $((w / 2)) $((h * 3 / 4)) $((w / 2)) $((h / 4)) 200
+		dev input swipe $((w / 2)) $((h / 4)) $((w / 2)) $((h * 3 / 4)) 200
+	done
+	dev dumpsys gfxinfo "$PKG" >"$WORK/gfxinfo"
+}
+
+gfx_value() {
+	awk -v key="$1" 'index($0, key ":") == 1 {
+		sub(/^[^:]*: */, ""); sub(/[^0-9.].*/, ""); print; exit }' \
+		"$WORK/gfxinfo"
+}
+
+gfx_jank_pct() {
+	sed -n 's/^Janky frames: [0-9]* (\([0-9.]*\)%)/\1/p' "$WORK/gfxinfo" |
+		head -n 1
+}
+
+METRICS="loader_ms initramfs_ms init_ms zygote_ms launcher_ms binder_rtt_us cold_start_ms
+	 frame_jank_pct frame_p50_ms frame_p90_ms frame_p99_ms"
+
+run=1
+while [ "$run" -le "$RUNS" ]; do
+	log "$BRANCH: boot $run/$RUNS"
+	boot_target
+
+	record loader_ms "$LOADER_MS"
+	record initramfs_ms "$(measure_initramfs)"
+	record init_ms "$(measure_init)"
+	record zygote_ms "$(measure_zygote)"
+	record launcher_ms "$(measure_launcher)"
+	record binder_rtt_us "$(measure_binder)"
+	record cold_start_ms "$(measure_cold_start)"
+
+	measure_frames
+	record frame_jank_pct "$(gfx_jank_pct)"
+	record frame_p50_ms "$(gfx_value '50th percentile')"
+	record frame_p90_ms "$(gfx_value '90th percentile')"
+	record frame_p99_ms "$(gfx_value '99th percentile')"
+
+	run=$((run + 1))
+done
+
+KREL=$(dev uname -r)
+CPU=$(dev cat /proc/cpuinfo | sed -n 's/^model name[[:space:]]*: //p' | head -n 1)
+stop_qemu
+
+mkdir -p "$OUTDIR"
+REPORT=$OUTDIR/$BRANCH.json
+{
+	echo "{"
+	echo "  \"branch\": $(json_str "$BRANCH"),"
+	echo "  \"kernel\": $(json_str "$KREL"),"
+	echo "  \"mode\": $(json_str "$MODE"),"
+	echo "  \"cpu\": $(json_str "$CPU"),"
+	echo "  \"runs\": $RUNS,"
+	echo "  \"metrics\": {"
+	json_metrics $METRICS
+	echo "  }"
+	echo "}"
+} >"$REPORT"
+
+log "wrote $REPORT"
@@ -0,0 +1,123 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# App cold start with and without prefetching the package's files.
+#
+#   coldstart-bench.sh -b crimson -a com.android.settings/.Settings
+#
+# First records which files the started app maps that zygote does not
+# (APK, oat, vdex, art, native libraries), then times "am start -W" from
+# a dropped page cache N times as is, and N times after reading that file
+# list back in one go. The prefetch time is reported on its own, so it
+# can be added to the prefetched start for a fair comparison. Writes
+# results/<branch>-coldstart.json.
+
+. "$(dirname "$0")/lib.sh"
+
+usage() {
+	cat >&2 <<EOF
+usage: $(basename "$0") -b <branch> [options]
+  -b <branch>     branch name recorded in the report
+  -a <component>  activity to start (default: com.android.settings/.Settings)
+  -s <serial>     adb serial of the target
+  -n <runs>       runs per mode (default: 10)
+  -o <dir>        report directory (default: results)
+EOF
+	exit 1
+}
+
+BRANCH=
+COMPONENT=com.android.settings/.Settings
+RUNS=10
+OUTDIR=results
+LIST=/data/local/tmp/prefetch.list
+
+while getopts b:a:s:n:o:h opt; do
+	case $opt in
+	b) BRANCH=$OPTARG ;;
+	a) COMPONENT=$OPTARG ;;
+	s) ADB="adb -s $OPTARG" ;;
+	n) RUNS=$OPTARG ;;
+	o) OUTDIR=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+
+[ -n "$BRANCH" ] || usage
+PKG=${COMPONENT%%/*}
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT INT TERM
+
+$ADB root >/dev/null 2>&1
+$ADB wait-for-device
+
+mapped_files() {
+	dev cat "/proc/$1/maps" |
+		awk '$6 ~ /^\// && $6 !~ /^\/(memfd:|dev\/)/ { print $6 }' | sort -u
+}
+
+drop_caches() {
+	dev am force-stop "$PKG"
+	dev "sync; echo 3 > /proc/sys/vm/drop_caches"
+	sleep 2
+}
+
+start_ms() {
+	dev am start -W -n "$COMPONENT" | awk -F': *' '/^TotalTime/ { print $2 }'
+}
+
+# Record the files only this app brings in.
+drop_caches
+start_ms >/dev/null
+sleep 5
+APP_PID=$(dev pidof "$PKG" | awk '{ print $1 }')
+[ -n "$APP_PID" ] || die "$PKG is not running"
+# The zygote the app was forked from, zygote64 or the 32-bit one.
+ZYGOTE_PID=$(dev cat "/proc/$APP_PID/stat" | sed 's/.*) //' | awk '{ print $2 }')
+mapped_files "$APP_PID" >"$WORK/app"
+mapped_files "$ZYGOTE_PID" >"$WORK/zygote"
+comm -23 "$WORK/app" "$WORK/zygote" >"$WORK/list"
+$ADB push "$WORK/list" "$LIST" >/dev/null
+FILES=$(($(wc -l <"$WORK/list")))
+PREFETCH_KB=$(dev "cat $LIST | xargs du -k" | awk '{ s += $1 } END { print s + 0 }')
+log "$PKG: $FILES files, $PREFETCH_KB kB to prefetch"
+
+run=1
+while [ "$run" -le "$RUNS" ]; do
+	log "$BRANCH: run $run/$RUNS"
+
+	drop_caches
+	record cold_ms "$(start_ms)"
+
+	drop_caches
+	# Timed on the host: nanosecond stamps overflow mksh's 32-bit
+	# arithmetic once prefetching takes more than about 2 s.
+	start=$(now_ms)
+	dev "while read -r f; do cat \"\$f\" >/dev/null; done <$LIST"
+	record prefetch_ms $(($(now_ms) - start))
+	record prefetched_cold_ms "$(start_ms)"
+
+	run=$((run + 1))
+done
+
+dev rm -f "$LIST"
+KREL=$(dev uname -r)
+
+mkdir -p "$OUTDIR"
+REPORT=$OUTDIR/$BRANCH-coldstart.json
+{
+	echo "{"
+	echo "  \"branch\": $(json_str "$BRANCH"),"
+	echo "  \"kernel\": $(json_str "$KREL"),"
+	echo "  \"component\": $(json_str "$COMPONENT"),"
+	echo "  \"prefetch_files\": $FILES,"
+	echo "  \"prefetch_kb\": $PREFETCH_KB,"
+	echo "  \"runs\": $RUNS,"
+	echo "  \"metrics\": {"
+	json_metrics cold_ms prefetch_ms prefetched_cold_ms
+	echo "  }"
+	echo "}"
+} >"$REPORT"
+
+log "wrote $REPORT"
@@ -0,0 +1,136 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Foreground read latency on /data, idle and while a background bulk
+# writer (standing in for an app update) runs in the background cgroup.
+#
+#   fgio-bench.sh -b serenade-zen [-s <adb serial>] [-f fio] [-g background]
+#
+# Needs an Android fio on the target or pushed with -f. Writes
+# results/<branch>-fgio.json with 4K random-read latency percentiles for
+# both cases; run tools/io/fg-io.sh on the target first to measure the
+# tuned setup.
+
+. "$(dirname "$0")/lib.sh"
+
+usage() {
+	cat >&2 <<EOF
+usage: $(basename "$0") -b <branch> [options]
+  -b <branch>   branch name recorded in the report
+  -s <serial>   adb serial of the target
+  -f <fio>      host path of an Android fio binary to push
+  -g <group>    cgroup the bulk writer runs in (default: background)
+  -w <MiB>      size of the file the bulk writer keeps rewriting
+                (default: 2048)
+  -t <secs>     duration of each read run (default: 30)
+  -o <dir>      report directory (default: results)
+EOF
+	exit 1
+}
+
+BRANCH=
+FIO=
+GROUP=background
+BULK_MB=2048
+DURATION=30
+OUTDIR=results
+TMP=/data/local/tmp
+
+while getopts b:s:f:g:w:t:o:h opt; do
+	case $opt in
+	b) BRANCH=$OPTARG ;;
+	s) ADB="adb -s $OPTARG" ;;
+	f) FIO=$OPTARG ;;
+	g) GROUP=$OPTARG ;;
+	w) BULK_MB=$OPTARG ;;
+	t) DURATION=$OPTARG ;;
+	o) OUTDIR=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+
+[ -n "$BRANCH" ] || usage
+
+WORK=$(mktemp -d)
+trap 'dev "pkill -f fgio-bulk; rm -f $TMP/fgio-*"; rm -rf "$WORK"' EXIT INT TERM
+
+$ADB root >/dev/null 2>&1
+$ADB wait-for-device
+
+if [ -n "$FIO" ]; then
+	$ADB push "$FIO" $TMP/fio >/dev/null && dev chmod 755 $TMP/fio
+	FIO_BIN=$TMP/fio
+elif [ -n "$(dev which fio)" ]; then
+	FIO_BIN=fio
+else
+	die "no fio on the target, pass -f"
+fi
+
+# The cgroup.procs (v2) or tasks (v1) file of the bulk writer's group.
+PROCS=$(dev "for f in /sys/fs/cgroup/$GROUP/cgroup.procs \
+		      /dev/blkio/$GROUP/tasks; do
+		[ -w \$f ] && { echo \$f; break; }; done")
+[ -n "$PROCS" ] || log "no $GROUP cgroup, bulk writer runs unconfined"
+
+# "p50 p99 p99.9" 4K random-read completion latency in usecs.
+read_latency() {
+	dev "$FIO_BIN" --name=fgio-read --filename=$TMP/fgio-read \
+		--size=512M --rw=randread --bs=4k --direct=1 --iodepth=1 \
+		--runtime="$DURATION" --time_based \
+		--percentile_list=50:99:99.9 \
+		--output-format=terse --terse-version=3 2>/dev/null |
+		awk -F';' '$5 == 0 {
+			for (i = 1; i <= NF; i++) {
+				split($i, kv, "%=")
+				if (kv[1] == "50.000000") p50 = kv[2]
+				if (kv[1] == "99.000000") p99 = kv[2]
+				if (kv[1] == "99.900000") p999 = kv[2]
+			}
+			print p50, p99, p999
+			exit
+		}'
+}
+
+# Rewrite a BULK_MB file with fsync over and over until stopped.
+start_bulk() {
+	dev "sh -c '${PROCS:+echo \$\$ > $PROCS;} while :; do \
+		dd if=/dev/zero of=$TMP/fgio-bulk bs=1048576 \
+		count=$BULK_MB conv=fsync; done' >/dev/null 2>&1 &"
+	sleep 2
+}
+
+# Lay out the read file once, so both runs read the same blocks.
+dev "$FIO_BIN" --name=fgio-read --filename=$TMP/fgio-read --size=512M \
+	--rw=write --bs=1M >/dev/null 2>&1
+
+log "idle reads"
+set -- $(read_latency)
+IDLE_P50=$1 IDLE_P99=$2 IDLE_P999=$3
+
+log "reads while $GROUP rewrites ${BULK_MB} MiB"
+start_bulk
+set -- $(read_latency)
+BULK_P50=$1 BULK_P99=$2 BULK_P999=$3
+dev "pkill -f fgio-bulk"
+
+# I/O scheduler of the disk holding /data.
+DATA_DEV=$(dev cat /proc/mounts | awk '$2 == "/data" { print $1; exit }')
+DATA_DEV=$(dev readlink -f "$DATA_DEV")
+SYS=$(dev readlink -f "/sys/class/block/${DATA_DEV##*/}")
+SCHED=$(dev "cat $SYS/queue/scheduler 2>/dev/null ||
+	     cat $SYS/../queue/scheduler 2>/dev/null")
+
+mkdir -p "$OUTDIR"
+REPORT=$OUTDIR/$BRANCH-fgio.json
+cat >"$REPORT" <<EOF
+{
+  "branch": $(json_str "$BRANCH"),
+  "kernel": $(json_str "$(dev uname -r)"),
+  "scheduler": $(json_str "$SCHED"),
+  "bulk_cgroup": $(json_str "${PROCS:-none}"),
+  "idle": { "p50_us": $(json_num "$IDLE_P50"), "p99_us": $(json_num "$IDLE_P99"), "p99.9_us": $(json_num "$IDLE_P999") },
+  "bulk": { "p50_us": $(json_num "$BULK_P50"), "p99_us": $(json_num "$BULK_P99"), "p99.9_us": $(json_num "$BULK_P999") }
+}
+EOF
+
+log "wrote $REPORT"
@@ -0,0 +1,103 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Boot-time initcall and driver probe profile from a kernel booted with
+# "initcall_debug" (boot-bench.sh -c initcall_debug, or the boot loader).
+#
+#   initcall-profile.sh -b serenade [-s <adb serial>] [-f dmesg.txt]
+#
+# Writes results/<branch>-initcalls.txt, one "usecs kind name" line per
+# initcall or synchronous probe (kind is initcall, probe or driver, and
+# module initcalls carry the module name as a fourth field), slowest first, so two branches or two builds of the same branch can be
+# diffed. Probes slower than -t usecs are resolved to their driver (device
+# names need a live target for that) and printed as a driver_async_probe=
+# line to try on the next boot.
+
+. "$(dirname "$0")/lib.sh"
+
+usage() {
+	cat >&2 <<EOF
+usage: $(basename "$0") -b <branch> [options]
+  -b <branch>   branch name used for the report file
+  -s <serial>   adb serial of the target
+  -f <file>     read a saved dmesg instead of the target's
+  -t <usecs>    async probe candidate threshold (default: 20000)
+  -o <dir>      report directory (default: results)
+EOF
+	exit 1
+}
+
+BRANCH=
+DMESG=
+THRESHOLD=20000
+OUTDIR=results
+
+while getopts b:s:f:t:o:h opt; do
+	case $opt in
+	b) BRANCH=$OPTARG ;;
+	s) ADB="adb -s $OPTARG" ;;
+	f) DMESG=$OPTARG ;;
+	t) THRESHOLD=$OPTARG ;;
+	o) OUTDIR=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+
+[ -n "$BRANCH" ] || usage
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT INT TERM
+
+if [ -n "$DMESG" ]; then
+	cp "$DMESG" "$WORK/dmesg" || exit 1
+else
+	$ADB root >/dev/null 2>&1
+	$ADB wait-for-device
+	dev dmesg >"$WORK/dmesg"
+fi
+
+grep -q 'initcall .* returned .* after' "$WORK/dmesg" ||
+	die "no initcall_debug output, boot with initcall_debug"
+
+#   initcall foo_init+0x0/0x40 returned 0 after 1234 usecs
+#   initcall azx_driver_init+0x0/0x1000 [snd_hda_intel] returned 0 after 4567 usecs
+#   probe of 0000:00:1f.3 returned 0 after 56789 usecs
+#   ... probe with driver snd_hda_intel returned 0 after 56789 usecs
+# Older kernels name the device, newer ones the driver.
+sed -n \
+	-e 's/.*initcall \([^ +]*\)[^ ]* \[\([^]]*\)\] returned .* after \([0-9]*\) usecs.*/\3 initcall \1 \2/p' \
+	-e 's/.*initcall \([^ +]*\)[^ ]* returned .* after \([0-9]*\) usecs.*/\2 initcall \1/p' \
+	-e 's/.*probe of \([^ ]*\) returned .* after \([0-9]*\) usecs.*/\2 probe \1/p' \
+	-e 's/.*probe with driver \([^ ]*\) returned .* after \([0-9]*\) usecs.*/\2 driver \1/p' \
+	"$WORK/dmesg" | sort -n -r >"$WORK/profile"
+
+mkdir -p "$OUTDIR"
+REPORT=$OUTDIR/$BRANCH-initcalls.txt
+cp "$WORK/profile" "$REPORT"
+
+awk '$2 == "initcall" { i += $1 } $2 != "initcall" { p += $1 }
+	END { printf "initcalls: %d ms, probes: %d ms\n", i / 1000, p / 1000 }' \
+	"$WORK/profile"
+echo "slowest:"
+head -n 15 "$WORK/profile"
+
+# Map slow probes to the drivers that bound the devices.
+awk -v t="$THRESHOLD" '$2 != "initcall" && $1 >= t { print $2, $3 }' \
+	"$WORK/profile" >"$WORK/slow"
+drivers=
+while read -r kind name; do
+	if [ "$kind" = driver ]; then
+		drv=$name
+	elif [ -n "$DMESG" ]; then
+		continue
+	else
+		drv=$(dev "readlink /sys/bus/*/devices/$name/driver" | head -n 1)
+		drv=${drv##*/}
+	fi
+	[ -n "$drv" ] || continue
+	case ",$drivers," in *",$drv,"*) continue ;; esac
+	drivers=${drivers:+$drivers,}$drv
+done <"$WORK/slow"
+
+[ -n "$drivers" ] && echo "async probe candidates: driver_async_probe=$drivers"
+log "wrote $REPORT"
@@ -0,0 +1,83 @@
+# SPDX-License-Identifier: GPL-2.0
+#
+# Helpers shared by the benchmark scripts in this directory.
+# Source it, don't run it.
+
+ADB=${ADB:-adb}
+
+die() {
+	echo "$(basename "$0"): $*" >&2
+	exit 1
+}
+
+log() {
+	echo "$(basename "$0"): $*" >&2
+}
+
+# Run a command on the target, with CR stripped from the output. stdin is
+# not forwarded, so this is safe inside "while read" loops.
+dev() {
+	$ADB shell "$@" </dev/null | tr -d '\r'
+}
+
+# Host wall clock in milliseconds.
+now_ms() {
+	echo $(($(date +%s%N) / 1000000))
+}
+
+# Wait until Android reports sys.boot_completed, or fail after $1 seconds.
+wait_boot_completed() {
+	timeout=${1:-300}
+	$ADB wait-for-device
+	while [ "$timeout" -gt 0 ]; do
+		[ "$(dev getprop sys.boot_completed)" = "1" ] && return 0
+		sleep 1
+		timeout=$((timeout - 1))
+	done
+	return 1
+}
+
+# Print the median of the numbers on stdin, or "null" when there are none.
+median() {
+	sort -n | awk '{ v[NR] = $1 }
+		END {
+			if (NR == 0) { print "null"; exit }
+			if (NR % 2) print v[(NR + 1) / 2]
+			else printf "%.1f\n", (v[NR / 2] + v[NR / 2 + 1]) / 2
+		}'
+}
+
+# Turn the numbers on stdin into a JSON array.
+json_array() {
+	awk 'BEGIN { printf "[" } { printf "%s%s", (NR > 1 ? ", " : ""), $1 }
+		END { printf "]" }'
+}
+
+# Print $1 as a JSON number, or null when it is empty.
+json_num() {
+	if [ -n "$1" ]; then echo "$1"; else echo null; fi
+}
+
+# Print $1 as a JSON string.
+json_str() {
+	printf '"%s"' "$(printf '%s' "$1" | sed 's/\\/\\\\/g; s/"/\\"/g')"
+}
+
+# Append sample $2 to metric $1 in $WORK, skipping empty measurements.
+record() {
+	[ -n "$2" ] && echo "$2" >>"$WORK/$1"
+}
+
+# Print the "metrics" members of a report for the metrics named in $@,
+# from the samples that record() collected in $WORK.
+json_metrics() {
+	sep=
+	for m; do
+		touch "$WORK/$m"
+		printf '%s    "%s": { "median": %s, "samples": %s }' "$sep" "$m" \
+			"$(median <"$WORK/$m")" "$(json_array <"$WORK/$m")"
+		sep=",
+"
+	done
+	echo
+}
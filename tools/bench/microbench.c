@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Scheduler and memory hot-path microbenchmarks, run by microbench.sh.
+ *
+ * Build it static so the same binary runs on the host and under Android:
+ *
+ *   cc -O2 -static -pthread -o microbench microbench.c
+ *
+ * Prints one "name value" line per result.
+ */
+#define _GNU_SOURCE
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CTXSW_LOOPS	100000
+#define FUTEX_LOOPS	10000
+#define FAULT_BYTES	(256UL << 20)	/* total, split across threads */
+#define MMAP_LOOPS	20000
+#define MMAP_BYTES	(64UL << 10)
+
+static long page_size;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void die(const char *what)
+{
+	perror(what);
+	exit(1);
+}
+
+static void pin_to(int cpu)
+{
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	sched_setaffinity(0, sizeof(set), &set);
+}
+
+static void unpin(void)
+{
+	long i, n = sysconf(_SC_NPROCESSORS_ONLN);
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	for (i = 0; i < n; i++)
+		CPU_SET(i, &set);
+	sched_setaffinity(0, sizeof(set), &set);
+}
+
+static long futex(atomic_int *uaddr, int op, int val)
+{
+	return syscall(SYS_futex, uaddr, op, val, NULL, NULL, 0);
+}
+
+/*
+ * Two processes on one CPU bounce a byte over a pair of pipes, so every
+ * round trip is two context switches.
+ */
+static void bench_ctxsw(void)
+{
+	int ping[2], pong[2];
+	uint64_t start;
+	pid_t pid;
+	char c = 0;
+	int i;
+
+	if (pipe(ping) || pipe(pong))
+		die("pipe");
+
+	pid = fork();
+	if (pid < 0)
+		die("fork");
+	if (!pid) {
+		pin_to(0);
+		for (i = 0; i < CTXSW_LOOPS; i++) {
+			if (read(ping[0], &c, 1) != 1 ||
+			    write(pong[1], &c, 1) != 1)
+				_exit(1);
+		}
+		_exit(0);
+	}
+
+	pin_to(0);
+	start = now_ns();
+	for (i = 0; i < CTXSW_LOOPS; i++) {
+		if (write(ping[1], &c, 1) != 1 || read(pong[0], &c, 1) != 1)
+			die("pipe io");
+	}
+	printf("ctxsw_pipe_ns %.0f\n",
+	       (double)(now_ns() - start) / (2.0 * CTXSW_LOOPS));
+	waitpid(pid, NULL, 0);
+	close(ping[0]);
+	close(ping[1]);
+	close(pong[0]);
+	close(pong[1]);
+	unpin();
+}
+
+static struct {
+	atomic_int word;
+	atomic_int waiting;
+	atomic_int done;
+	atomic_uint_fast64_t woken_at;
+} fw;
+
+static void *futex_waiter(void *unused)
+{
+	int i;
+
+	pin_to(1);
+	for (i = 0; i < FUTEX_LOOPS; i++) {
+		atomic_store(&fw.waiting, 1);
+		while (atomic_load(&fw.word) == 0)
+			futex(&fw.word, FUTEX_WAIT_PRIVATE, 0);
+		atomic_store(&fw.woken_at, now_ns());
+		atomic_store(&fw.word, 0);
+		atomic_store(&fw.done, 1);
+	}
+	return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/*
+ * Cross-CPU wake-up latency: time from FUTEX_WAKE to the sleeping
+ * thread running again.
+ */
+static void bench_futex(void)
+{
+	uint64_t *lat;
+	pthread_t thr;
+	int i;
+
+	if (sysconf(_SC_NPROCESSORS_ONLN) < 2)
+		return;
+
+	lat = calloc(FUTEX_LOOPS, sizeof(*lat));
+	if (!lat)
+		die("calloc");
+
+	pthread_create(&thr, NULL, futex_waiter, NULL);
+	pin_to(0);
+	for (i = 0; i < FUTEX_LOOPS; i++) {
+		uint64_t start;
+
+		while (!atomic_load(&fw.waiting))
+			;
+		atomic_store(&fw.waiting, 0);
+		/* Give the waiter time to actually go to sleep. */
+		usleep(50);
+
+		start = now_ns();
+		atomic_store(&fw.word, 1);
+		futex(&fw.word, FUTEX_WAKE_PRIVATE, 1);
+		while (!atomic_load(&fw.done))
+			;
+		atomic_store(&fw.done, 0);
+		lat[i] = atomic_load(&fw.woken_at) - start;
+	}
+	pthread_join(thr, NULL);
+	unpin();
+
+	qsort(lat, FUTEX_LOOPS, sizeof(*lat), cmp_u64);
+	printf("futex_wake_p50_ns %llu\n",
+	       (unsigned long long)lat[FUTEX_LOOPS / 2]);
+	printf("futex_wake_p99_ns %llu\n",
+	       (unsigned long long)lat[FUTEX_LOOPS * 99 / 100]);
+	free(lat);
+}
+
+struct scale_arg {
+	pthread_barrier_t *barrier;
+	unsigned long bytes;
+	uint64_t ops;
+	int mode;
+};
+
+enum { SCALE_FAULT, SCALE_MMAP };
+
+static void *scale_worker(void *p)
+{
+	struct scale_arg *arg = p;
+	unsigned long off;
+	char *buf;
+	int i;
+
+	pthread_barrier_wait(arg->barrier);
+
+	if (arg->mode == SCALE_FAULT) {
+		buf = mmap(NULL, arg->bytes, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (buf == MAP_FAILED)
+			die("mmap");
+		/* Count 4K faults, not whatever THP would turn them into. */
+		madvise(buf, arg->bytes, MADV_NOHUGEPAGE);
+		for (off = 0; off < arg->bytes; off += page_size)
+			buf[off] = 1;
+		arg->ops = arg->bytes / page_size;
+		munmap(buf, arg->bytes);
+	} else {
+		for (i = 0; i < MMAP_LOOPS; i++) {
+			buf = mmap(NULL, MMAP_BYTES, PROT_READ | PROT_WRITE,
+				   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (buf == MAP_FAILED)
+				die("mmap");
+			buf[0] = 1;
+			munmap(buf, MMAP_BYTES);
+		}
+		arg->ops = MMAP_LOOPS;
+	}
+	return NULL;
+}
+
+/*
+ * Run @mode on 1, 2, 4, ... threads up to the number of CPUs, all in one
+ * mm so they contend on the same mmap lock, and print operations per
+ * second for each thread count. Fault threads share FAULT_BYTES, so the
+ * footprint stays the same however many CPUs there are.
+ */
+static void bench_scale(int mode, const char *name)
+{
+	int ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+	int nr, i;
+
+	for (nr = 1; ; nr = nr * 2 > ncpu && nr < ncpu ? ncpu : nr * 2) {
+		struct scale_arg *args = calloc(nr, sizeof(*args));
+		pthread_t *thr = calloc(nr, sizeof(*thr));
+		pthread_barrier_t barrier;
+		uint64_t start, ops = 0;
+
+		if (!args || !thr)
+			die("calloc");
+
+		pthread_barrier_init(&barrier, NULL, nr + 1);
+		for (i = 0; i < nr; i++) {
+			args[i].barrier = &barrier;
+			args[i].mode = mode;
+			args[i].bytes = FAULT_BYTES / nr / page_size * page_size;
+			pthread_create(&thr[i], NULL, scale_worker, &args[i]);
+		}
+		pthread_barrier_wait(&barrier);
+		start = now_ns();
+		for (i = 0; i < nr; i++) {
+			pthread_join(thr[i], NULL);
+			ops += args[i].ops;
+		}
+		printf("%s_%dt_per_s %.0f\n", name, nr,
+		       ops * 1e9 / (double)(now_ns() - start));
+
+		pthread_barrier_destroy(&barrier);
+		free(args);
+		free(thr);
+		if (nr >= ncpu)
+			break;
+	}
+}
+
+int main(void)
+{
+	page_size = sysconf(_SC_PAGESIZE);
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	bench_ctxsw();
+	bench_futex();
+	bench_scale(SCALE_FAULT, "pagefault");
+	bench_scale(SCALE_MMAP, "mmap_munmap");
+	return 0;
+}
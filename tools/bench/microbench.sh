@@ -0,0 +1,104 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Scheduler, binder and memory hot-path microbenchmarks. Runs where it is
+# started, so for Android push this directory and a static microbench
+# binary (see microbench.c) to the target first:
+#
+#   adb push tools/bench /data/local/tmp/bench
+#   adb shell sh /data/local/tmp/bench/microbench.sh >results/serenade-micro.txt
+#
+# Output is sorted "name value" lines, one per result, so runs of two
+# branches diff cleanly. "microbench.sh -c old.txt new.txt" prints the
+# change per result instead.
+
+DIR=$(dirname "$0")
+BIN=${BIN:-$DIR/microbench}
+ZRAM_MB=${ZRAM_MB:-128}
+ZRAM_SRC=${ZRAM_SRC:-/system/lib64 /system/framework /usr/lib}
+
+compare() {
+	awk 'NR == FNR { old[$1] = $2; next }
+		$1 == "kernel" { printf "%-28s %14s %14s\n", $1, old[$1], $2; next }
+		{
+			if ($1 in old && old[$1] != 0)
+				printf "%-28s %14s %14s %+8.1f%%\n", $1, old[$1], $2,
+					($2 - old[$1]) * 100 / old[$1]
+			else
+				printf "%-28s %14s %14s %9s\n", $1, "-", $2, "new"
+		}' "$1" "$2"
+}
+
+# Rate in MiB/s for $1 MiB between two "date +%s%N" stamps. Done in awk,
+# as nanosecond values overflow mksh's 32-bit arithmetic.
+mb_per_s() {
+	awk -v mb="$1" -v s="$2" -v e="$3" \
+		'BEGIN { if (e > s) printf "%.0f\n", mb * 1e9 / (e - s) }'
+}
+
+# zram compress and decompress rate on a fresh device, with library and
+# framework files as data so the ratio is realistic.
+bench_zram() {
+	[ -e /sys/class/zram-control/hot_add ] || return
+	tmp=$(mktemp) || return
+
+	# shellcheck disable=SC2086
+	find $ZRAM_SRC -type f 2>/dev/null | xargs cat 2>/dev/null |
+		head -c $((ZRAM_MB * 1048576)) >"$tmp"
+	mb=$(($(wc -c <"$tmp") / 1048576))
+	[ "$mb" -gt 0 ] || { rm -f "$tmp"; return; }
+	cat "$tmp" >/dev/null
+
+	id=$(cat /sys/class/zram-control/hot_add)
+	sys=/sys/block/zram$id
+	dev=/dev/block/zram$id
+	[ -b "$dev" ] || dev=/dev/zram$id
+
+	if [ -b "$dev" ]; then
+		[ -n "$ZRAM_ALGO" ] && echo "$ZRAM_ALGO" >"$sys/comp_algorithm"
+		echo "${ZRAM_MB}M" >"$sys/disksize"
+
+		start=$(date +%s%N)
+		dd if="$tmp" of="$dev" bs=1048576 conv=fsync 2>/dev/null
+		echo "zram_comp_mb_per_s $(mb_per_s "$mb" "$start" "$(date +%s%N)")"
+
+		echo 3 >/proc/sys/vm/drop_caches
+		start=$(date +%s%N)
+		dd if="$dev" of=/dev/null bs=1048576 2>/dev/null
+		echo "zram_decomp_mb_per_s $(mb_per_s "$mb" "$start" "$(date +%s%N)")"
+
+		awk '{ if ($2) printf "zram_ratio %.2f\n", $1 / $2 }' \
+			"$sys/mm_stat"
+	fi
+
+	rm -f "$tmp"
+	echo 1 >"$sys/reset"
+	echo "$id" >/sys/class/zram-control/hot_remove
+}
+
+# Binder round trip from AOSP's binderThroughputTest, when installed.
+bench_binder() {
+	for bin in /data/nativetest64/binderThroughputTest/binderThroughputTest \
+		   /data/nativetest/binderThroughputTest/binderThroughputTest; do
+		[ -x "$bin" ] || continue
+		"$bin" -w 2 -i 10000 |
+			sed -n 's/.*average:\([0-9.]*\)ms.*/\1/p' |
+			awk 'NR == 1 { printf "binder_rtt_ns %.0f\n", $1 * 1000000 }'
+		return
+	done
+}
+
+if [ "$1" = -c ]; then
+	[ $# -eq 3 ] || { echo "usage: $(basename "$0") -c <old> <new>" >&2; exit 1; }
+	compare "$2" "$3"
+	exit
+fi
+
+[ -x "$BIN" ] || { echo "$(basename "$0"): no $BIN, build microbench.c" >&2; exit 1; }
+
+{
+	echo "kernel $(uname -r)"
+	"$BIN"
+	bench_binder
+	[ "$(id -u)" = 0 ] && bench_zram
+} | sort
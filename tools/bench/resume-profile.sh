@@ -0,0 +1,127 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Per-device resume latency report. Suspends the target once with
+# pm_print_times on, wakes it from the RTC and turns the resume half of the
+# dmesg into results/<branch>-resume.txt: one "usecs device async" line
+# per device callback, slowest first, where async is the power/async
+# setting of devices above the -t threshold. The time from the resume
+# marker to "PM: suspend exit" is printed as well.
+#
+#   resume-profile.sh -b serenade-surface [-s <adb serial>] [-w 10]
+#
+# With -e the slow devices that still resume synchronously get
+# power/async enabled, to try on the next run.
+
+. "$(dirname "$0")/lib.sh"
+
+usage() {
+	cat >&2 <<EOF
+usage: $(basename "$0") -b <branch> [options]
+  -b <branch>   branch name used for the report file
+  -s <serial>   adb serial of the target
+  -w <secs>     time asleep before the RTC wakes the target (default: 10)
+  -t <usecs>    threshold for "slow" devices (default: 10000)
+  -e            enable async resume on slow synchronous devices
+  -o <dir>      report directory (default: results)
+EOF
+	exit 1
+}
+
+BRANCH=
+WAKE=10
+THRESHOLD=10000
+ENABLE=0
+OUTDIR=results
+
+while getopts b:s:w:t:eo:h opt; do
+	case $opt in
+	b) BRANCH=$OPTARG ;;
+	s) ADB="adb -s $OPTARG" ;;
+	w) WAKE=$OPTARG ;;
+	t) THRESHOLD=$OPTARG ;;
+	e) ENABLE=1 ;;
+	o) OUTDIR=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+
+[ -n "$BRANCH" ] || usage
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT INT TERM
+
+$ADB root >/dev/null 2>&1
+$ADB wait-for-device
+
+# pm_debug_messages turns on the s2idle resume marker and the per-phase
+# "took"/"complete after" lines, which are pm_pr_dbg() on newer kernels.
+PM_DEBUG=$(dev cat /sys/power/pm_debug_messages 2>/dev/null)
+dev "echo 1 > /sys/power/pm_print_times; echo 1 > /sys/power/pm_async;
+     echo 1 > /sys/power/pm_debug_messages" 2>/dev/null
+dev dmesg -c >/dev/null
+
+# Android keeps a wakelock while adb is connected, so suspend explicitly
+# and let the RTC bring the target back.
+log "suspending for $WAKE s"
+dev "echo 0 > /sys/class/rtc/rtc0/wakealarm;
+     echo +$WAKE > /sys/class/rtc/rtc0/wakealarm;
+     echo mem > /sys/power/state" >/dev/null 2>&1
+sleep 5
+$ADB wait-for-device
+dev dmesg >"$WORK/dmesg"
+[ -n "$PM_DEBUG" ] &&
+	dev "echo $PM_DEBUG > /sys/power/pm_debug_messages"
+
+# Resume starts at the first of these markers (S3 or s2idle). Without
+# any, fall back to "PM: suspend entry" (pr_info) and keep only resume
+# callbacks.
+RESUME_ONLY=0
+awk '/Waking up from system sleep|resume from suspend-to-idle|Enabling non-boot CPUs/ { r = 1 }
+	r' "$WORK/dmesg" >"$WORK/resume"
+if [ ! -s "$WORK/resume" ]; then
+	awk '/PM: suspend entry/ { r = 1 } r' "$WORK/dmesg" >"$WORK/resume"
+	RESUME_ONLY=1
+fi
+[ -s "$WORK/resume" ] || die "target did not suspend, see dmesg"
+
+# "usecs device callback", from the dev_info() form of 4.16+ or the old
+# "call" form as a fallback:
+#   pci 0000:00:14.0: pci_pm_resume+0x0/0xf0 returned 0 after 40000 usecs
+#   call 0000:00:14.0+ returned 0 after 123456 usecs
+sed -n \
+	-e 's/^\(\[[^]]*\] *\)\{0,1\}[^ ]* \([^ ]*\): \([^ +]*\)+0x[0-9a-f]*\/0x[0-9a-f]* returned .* after \([0-9]*\) usecs.*/\4 \2 \3/p' \
+	-e 's/.*call \([^ ]*\)+ returned .* after \([0-9]*\) usecs.*/\2 \1 -/p' \
+	"$WORK/resume" |
+	awk -v only="$RESUME_ONLY" '!only || $3 ~ /resume|restore|complete/ { print $1, $2 }' |
+	sort -n -r >"$WORK/calls"
+[ -s "$WORK/calls" ] || die "no device resume times in dmesg (pm_print_times?)"
+
+# Only look up power/async for slow devices, sysfs walks are not free.
+while read -r usecs name; do
+	async=-
+	if [ "$usecs" -ge "$THRESHOLD" ]; then
+		path=$(dev "find /sys/devices -maxdepth 8 -name '$name' 2>/dev/null" |
+			head -n 1)
+		async=$(dev "cat $path/power/async 2>/dev/null")
+		async=${async:-unknown}
+	fi
+	echo "$usecs $name $async"
+	if [ "$ENABLE" = 1 ] && [ "$usecs" -ge "$THRESHOLD" ] &&
+	   [ "$async" = disabled ]; then
+		dev "echo enabled > $path/power/async"
+	fi
+done <"$WORK/calls" >"$WORK/report"
+
+mkdir -p "$OUTDIR"
+REPORT=$OUTDIR/$BRANCH-resume.txt
+cp "$WORK/report" "$REPORT"
+
+grep -h 'PM: resume.* took\|PM: .*resume of devices complete after' \
+	"$WORK/resume"
+awk -F'[][]' 'NR == 1 { s = $2 } /PM: suspend exit/ { e = $2; exit }
+	END { if (e != "") printf "resume: %d ms\n", (e - s) * 1000 }' \
+	"$WORK/resume"
+echo "slowest:"
+head -n 15 "$WORK/report"
+log "wrote $REPORT"
@@ -0,0 +1,137 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Storage path benchmark for a booted Android-x86 target: package install
+# time, dex2oat time and I/O, and io_uring fixed-buffer throughput on
+# /data. Also records whether /data is f2fs with compression.
+#
+#   storage-bench.sh -b serenade -p app.apk -P com.example.app [-f fio]
+#
+# The io_uring numbers need an Android build of fio, either on the target
+# or pushed from the host with -f.
+
+. "$(dirname "$0")/lib.sh"
+
+usage() {
+	cat >&2 <<EOF
+usage: $(basename "$0") -b <branch> -p <apk> -P <package> [options]
+  -b <branch>   branch name recorded in the report
+  -p <apk>      APK installed on every run
+  -P <package>  package name of that APK
+  -s <serial>   adb serial of the target
+  -f <fio>      host path of an Android fio binary to push
+  -n <runs>     number of runs (default: 5)
+  -o <dir>      report directory (default: results)
+EOF
+	exit 1
+}
+
+BRANCH=
+APK=
+PKG=
+FIO=
+RUNS=5
+OUTDIR=results
+
+while getopts b:p:P:s:f:n:o:h opt; do
+	case $opt in
+	b) BRANCH=$OPTARG ;;
+	p) APK=$OPTARG ;;
+	P) PKG=$OPTARG ;;
+	s) ADB="adb -s $OPTARG" ;;
+	f) FIO=$OPTARG ;;
+	n) RUNS=$OPTARG ;;
+	o) OUTDIR=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+
+[ -n "$BRANCH" ] && [ -f "$APK" ] && [ -n "$PKG" ] || usage
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT INT TERM
+
+$ADB root >/dev/null 2>&1
+$ADB wait-for-device
+
+# Block device behind /data and its mount options.
+DATA_MNT=$(dev cat /proc/mounts | awk '$2 == "/data" { print; exit }')
+DATA_FS=$(echo "$DATA_MNT" | awk '{ print $3 }')
+DATA_DEV=$(dev readlink -f "$(echo "$DATA_MNT" | awk '{ print $1 }')")
+DATA_DEV=${DATA_DEV##*/}
+COMPRESS=$(echo "$DATA_MNT" |
+	sed -n 's/.*compress_algorithm=\([^,[:space:]]*\).*/\1/p')
+
+# Sectors read and written on the /data device so far.
+disk_sectors() {
+	dev cat /proc/diskstats |
+		awk -v d="$DATA_DEV" '$3 == d { print $6, $10 }'
+}
+
+FIO_BIN=
+if [ -n "$FIO" ]; then
+	$ADB push "$FIO" /data/local/tmp/fio >/dev/null &&
+		dev chmod 755 /data/local/tmp/fio && FIO_BIN=/data/local/tmp/fio
+elif [ -n "$(dev which fio)" ]; then
+	FIO_BIN=fio
+fi
+
+# Random-read bandwidth in KiB/s through io_uring with registered
+# buffers and files; empty if fio or the kernel cannot do it.
+measure_uring() {
+	[ -n "$FIO_BIN" ] || return
+	dev "$FIO_BIN" --name=uring --ioengine=io_uring --fixedbufs \
+		--registerfiles --direct=1 --rw=randread --bs=128k --iodepth=32 \
+		--size=256M --runtime=10 --time_based \
+		--filename=/data/local/tmp/fio.dat \
+		--output-format=terse --terse-version=3 2>/dev/null |
+		awk -F';' '$5 == 0 { print $7 }'
+	dev rm -f /data/local/tmp/fio.dat
+}
+
+run=1
+while [ "$run" -le "$RUNS" ]; do
+	log "$BRANCH: run $run/$RUNS"
+	$ADB uninstall "$PKG" >/dev/null 2>&1
+	dev "sync; echo 3 > /proc/sys/vm/drop_caches"
+
+	start=$(now_ms)
+	$ADB install -r -g "$APK" >/dev/null || die "install failed"
+	record install_ms $(($(now_ms) - start))
+
+	set -- $(disk_sectors)
+	start=$(now_ms)
+	dev cmd package compile -m speed -f "$PKG" >/dev/null
+	record dex2oat_ms $(($(now_ms) - start))
+	rd=$1
+	wr=$2
+	set -- $(disk_sectors)
+	if [ -n "$rd" ] && [ -n "$1" ]; then
+		record dex2oat_read_kb $((($1 - rd) / 2))
+		record dex2oat_write_kb $((($2 - wr) / 2))
+	fi
+
+	record uring_fixedbuf_kbps "$(measure_uring)"
+
+	run=$((run + 1))
+done
+
+KREL=$(dev uname -r)
+
+mkdir -p "$OUTDIR"
+REPORT=$OUTDIR/$BRANCH-storage.json
+{
+	echo "{"
+	echo "  \"branch\": $(json_str "$BRANCH"),"
+	echo "  \"kernel\": $(json_str "$KREL"),"
+	echo "  \"data_fs\": $(json_str "$DATA_FS"),"
+	echo "  \"f2fs_compress\": $(json_str "${COMPRESS:-none}"),"
+	echo "  \"runs\": $RUNS,"
+	echo "  \"metrics\": {"
+	json_metrics install_ms dex2oat_ms dex2oat_read_kb dex2oat_write_kb \
+		uring_fixedbuf_kbps
+	echo "  }"
+	echo "}"
+} >"$REPORT"
+
+log "wrote $REPORT"
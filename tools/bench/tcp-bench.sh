@@ -0,0 +1,130 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# TCP throughput per congestion control algorithm over emulated links.
+# Runs on the machine booted with the kernel under test (as root, needs
+# ip, tc with netem and iperf3): two network namespaces joined by a veth
+# pair, netem on the sender side, one iperf3 run per algorithm and link.
+#
+#   tcp-bench.sh -b crimson-xanmod [-c "cubic bbr"] [-t 20]
+#
+# Writes results/<branch>-tcp.json with Mbit/s and retransmits for every
+# algorithm the kernel offers (or the -c list) on each link profile.
+
+. "$(dirname "$0")/lib.sh"
+
+usage() {
+	cat >&2 <<EOF
+usage: $(basename "$0") -b <branch> [options]
+  -b <branch>  branch name recorded in the report
+  -c <algos>   congestion control algorithms (default: all available)
+  -t <secs>    duration of each run (default: 20)
+  -o <dir>     report directory (default: results)
+EOF
+	exit 1
+}
+
+BRANCH=
+ALGOS=
+DURATION=20
+OUTDIR=results
+
+# name:delay:jitter:loss:rate, applied to the sender's egress.
+LINKS="lan:1ms:0ms:0%:1gbit
+wifi:20ms:5ms:0.1%:100mbit
+lte:50ms:10ms:1%:30mbit
+lossy:100ms:20ms:3%:10mbit"
+
+while getopts b:c:t:o:h opt; do
+	case $opt in
+	b) BRANCH=$OPTARG ;;
+	c) ALGOS=$OPTARG ;;
+	t) DURATION=$OPTARG ;;
+	o) OUTDIR=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+
+[ -n "$BRANCH" ] || usage
+[ "$(id -u)" = 0 ] || die "must run as root"
+for tool in ip tc iperf3; do
+	command -v $tool >/dev/null || die "$tool not found"
+done
+
+NS_TX=tcpbench-tx
+NS_RX=tcpbench-rx
+SERVER=
+
+cleanup() {
+	[ -n "$SERVER" ] && kill "$SERVER" 2>/dev/null
+	ip netns del $NS_TX 2>/dev/null
+	ip netns del $NS_RX 2>/dev/null
+}
+trap cleanup EXIT INT TERM
+
+ip netns add $NS_TX
+ip netns add $NS_RX
+ip link add veth-tx netns $NS_TX type veth peer name veth-rx netns $NS_RX
+ip -n $NS_TX addr add 10.99.0.1/24 dev veth-tx
+ip -n $NS_RX addr add 10.99.0.2/24 dev veth-rx
+ip -n $NS_TX link set veth-tx up
+ip -n $NS_RX link set veth-rx up
+ip -n $NS_TX link set lo up
+ip -n $NS_RX link set lo up
+
+ip netns exec $NS_RX iperf3 -s >/dev/null 2>&1 &
+SERVER=$!
+sleep 1
+
+[ -n "$ALGOS" ] ||
+	ALGOS=$(cat /proc/sys/net/ipv4/tcp_available_congestion_control)
+
+# Prints "<Mbit/s> <retransmits>" for one run with algorithm $1.
+run_iperf() {
+	ip netns exec $NS_TX iperf3 -c 10.99.0.2 -C "$1" -t "$DURATION" -J |
+		awk '
+			/"sum_sent"/ { sent = 1 }
+			sent && /"bits_per_second"/ {
+				gsub(/[^0-9.e+]/, "", $2); bps = $2 }
+			sent && /"retransmits"/ {
+				gsub(/[^0-9]/, "", $2); rtx = $2; exit }
+			END { if (bps != "") printf "%.1f %d\n", bps / 1e6, rtx }'
+}
+
+mkdir -p "$OUTDIR"
+REPORT=$OUTDIR/$BRANCH-tcp.json
+{
+	echo "{"
+	echo "  \"branch\": $(json_str "$BRANCH"),"
+	echo "  \"kernel\": $(json_str "$(uname -r)"),"
+	echo "  \"duration_s\": $DURATION,"
+	echo "  \"links\": {"
+	lsep=
+	for l in $LINKS; do
+		IFS=: read -r name delay jitter loss rate <<EOF
+$l
+EOF
+		ip netns exec $NS_TX tc qdisc replace dev veth-tx root netem \
+			delay "$delay" "$jitter" loss "$loss" rate "$rate"
+
+		printf '%s    %s: {\n' "$lsep" "$(json_str "$name")"
+		asep=
+		for a in $ALGOS; do
+			log "$name: $a"
+			set -- $(run_iperf "$a")
+			printf '%s      %s: { "mbps": %s, "retransmits": %s }' \
+				"$asep" "$(json_str "$a")" \
+				"$(json_num "$1")" "$(json_num "$2")"
+			asep=",
+"
+		done
+		printf '\n    }'
+		lsep=",
+"
+	done
+	echo
+	echo "  }"
+	echo "}"
+} >"$REPORT"
+
+log "wrote $REPORT"
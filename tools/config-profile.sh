@@ -0,0 +1,128 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Merge a performance profile from configs/ into one or more kernel trees
+# and report, per tree, which options did not survive olddefconfig:
+#
+#   dropped      the symbol exists, but its dependencies are not met
+#   unsupported  the branch does not have the symbol at all
+#
+#   config-profile.sh [-a] [-b <defconfig>] <profile> <kernel tree>...
+#
+# <profile> is a name from configs/ (performance, battery, lowram) or a
+# path to a fragment. The base is the tree's .config, or <defconfig> from
+# arch/x86/configs/. Nothing in the tree is touched unless -a is given,
+# in which case the merged result replaces .config (the old one is kept
+# as .config.old). Exits non-zero when any tree dropped an option.
+
+usage() {
+	echo "usage: $(basename "$0") [-a] [-b <defconfig>] <profile> <kernel tree>..." >&2
+	exit 1
+}
+
+die() {
+	echo "$(basename "$0"): $*" >&2
+	exit 1
+}
+
+APPLY=0
+DEFCONFIG=
+
+while getopts ab:h opt; do
+	case $opt in
+	a) APPLY=1 ;;
+	b) DEFCONFIG=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+[ $# -ge 2 ] || usage
+
+PROFILE=$1
+shift
+[ -f "$PROFILE" ] || PROFILE=$(dirname "$0")/../configs/$PROFILE.config
+[ -f "$PROFILE" ] || die "no such profile: $1"
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT INT TERM
+
+# "SYMBOL VALUE" for every option in the fragment, "n" for "is not set".
+sed -n -e 's/^CONFIG_\([A-Za-z0-9_]*\)=\(.*\)/\1 \2/p' \
+       -e 's/^# CONFIG_\([A-Za-z0-9_]*\) is not set/\1 n/p' \
+       "$PROFILE" >"$WORK/want"
+
+# Value of every symbol in a .config, in the same format.
+config_values() {
+	sed -n -e 's/^CONFIG_\([A-Za-z0-9_]*\)=\(.*\)/\1 \2/p' \
+	       -e 's/^# CONFIG_\([A-Za-z0-9_]*\) is not set/\1 n/p' "$1"
+}
+
+# Apply the fragment on top of $1 the way merge_config.sh does: later
+# assignments replace earlier ones.
+merge_fragment() {
+	cut -d' ' -f1 "$WORK/want" | sed 's/.*/^\\(# \\)\\{0,1\\}CONFIG_&[= ]/' \
+		>"$WORK/patterns"
+	grep -v -f "$WORK/patterns" "$1" >"$1.merged"
+	grep -E '^(CONFIG_|# CONFIG_.* is not set)' "$PROFILE" >>"$1.merged"
+	mv "$1.merged" "$1"
+}
+
+check_tree() {
+	tree=$1
+	cfg=$WORK/config
+
+	[ -f "$tree/Makefile" ] && [ -d "$tree/scripts/kconfig" ] ||
+		{ echo "$tree: not a kernel tree" >&2; return 2; }
+
+	if [ -n "$DEFCONFIG" ]; then
+		cp "$tree/arch/x86/configs/$DEFCONFIG" "$cfg" ||
+			return 2
+	elif [ -f "$tree/.config" ]; then
+		cp "$tree/.config" "$cfg"
+	else
+		echo "$tree: no .config, pass -b <defconfig>" >&2
+		return 2
+	fi
+
+	merge_fragment "$cfg"
+	make -s -C "$tree" KCONFIG_CONFIG="$cfg" olddefconfig >/dev/null ||
+		{ echo "$tree: olddefconfig failed" >&2; return 2; }
+
+	find "$tree" -name 'Kconfig*' -exec sed -n \
+		's/^[[:space:]]*\(menu\)\{0,1\}config[[:space:]]\{1,\}\([A-Za-z0-9_]*\).*/\2/p' \
+		{} + | sort -u >"$WORK/symbols"
+	config_values "$cfg" | sort >"$WORK/have"
+
+	version=$(make -s -C "$tree" kernelversion 2>/dev/null)
+	ok=0
+	bad=0
+	while read -r sym want; do
+		have=$(awk -v s="$sym" '$1 == s { print $2 }' "$WORK/have")
+		[ -n "$have" ] || have=n
+		if [ "$have" = "$want" ]; then
+			ok=$((ok + 1))
+		elif ! grep -qx "$sym" "$WORK/symbols"; then
+			echo "  unsupported  CONFIG_$sym"
+			bad=$((bad + 1))
+		else
+			echo "  dropped      CONFIG_$sym=$want (got $have)"
+			bad=$((bad + 1))
+		fi
+	done <"$WORK/want" >"$WORK/report"
+
+	echo "$tree ($version): $ok ok, $bad not applied"
+	cat "$WORK/report"
+
+	if [ "$APPLY" = 1 ]; then
+		[ -f "$tree/.config" ] && cp "$tree/.config" "$tree/.config.old"
+		cp "$cfg" "$tree/.config"
+	fi
+
+	[ "$bad" = 0 ]
+}
+
+status=0
+for tree; do
+	check_tree "$tree" || status=1
+done
+exit $status
@@ -0,0 +1,141 @@
+#!/system/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Keep foreground I/O ahead of background bulk writes (app updates,
+# dex2oat, backups) on every disk:
+#
+#  - BFQ with low_latency where the kernel has it (every profile in
+#    configs/ enables it), mq-deadline otherwise, and writeback
+#    throttling (wbt) on;
+#  - cgroup v2: an io.latency target for the foreground groups, and a low
+#    io.weight/io.bfq.weight for the background ones;
+#  - cgroup v1 blkio (older Android): BFQ weights for the same groups.
+#
+#	fg-io.sh apply
+#
+# Group names follow Android's cpuset/blkio naming and can be changed;
+# they are paths relative to the cgroup root. Stock Android only has
+# top-app/foreground/background as v1 cpusets and "background" in v1
+# blkio, while its v2 hierarchy holds uid_*/pid_*, so point FG_GROUPS and
+# BG_GROUPS at the v2 groups the apps are actually in. Every group that
+# was configured is logged, and apply fails when there were none.
+
+CGROOT=${CGROOT:-/sys/fs/cgroup}
+BLKIO=${BLKIO:-/dev/blkio}
+FG_GROUPS=${FG_GROUPS:-top-app foreground}
+BG_GROUPS=${BG_GROUPS:-background system-background}
+SCHED=${SCHED:-}			# force an I/O scheduler
+LAT_SSD_US=${LAT_SSD_US:-5000}		# io.latency target, non-rotational
+LAT_HDD_US=${LAT_HDD_US:-50000}		# io.latency target, rotational
+WBT_SSD_US=${WBT_SSD_US:-2000}
+WBT_HDD_US=${WBT_HDD_US:-75000}
+
+FG_DONE=0
+BG_DONE=0
+
+log() {
+	echo "fg-io: $*" >&2
+}
+
+# Disks, not partitions, device-mapper or zram.
+disks() {
+	for q in /sys/block/*/queue; do
+		d=${q%/queue}
+		case ${d##*/} in loop*|ram*|zram*|dm-*) continue ;; esac
+		echo "${d##*/}"
+	done
+}
+
+set_sched() {
+	q=/sys/block/$1/queue
+	avail=$(cat "$q/scheduler")
+	want=$SCHED
+	if [ -z "$want" ]; then
+		case $avail in
+		*bfq*) want=bfq ;;
+		*mq-deadline*) want=mq-deadline ;;
+		*) return ;;
+		esac
+	fi
+	echo "$want" >"$q/scheduler" 2>/dev/null || return
+
+	# slice_idle is left alone: BFQ only enforces the group weights
+	# below while it idles, on SSDs too.
+	[ "$want" = bfq ] && echo 1 >"$q/iosched/low_latency"
+}
+
+# Enable io in subtree_control of every level from the root down to the
+# parent of group $1, so nested groups such as apps/uid_* get io.* files.
+enable_io_to() {
+	local parent=${1%/*}
+	[ "$parent" = "$CGROOT" ] || enable_io_to "$parent"
+	grep -qw io "$parent/cgroup.subtree_control" ||
+		echo +io >"$parent/cgroup.subtree_control" 2>/dev/null
+}
+
+# cgroup v2 io.latency / io.weight for disk $1 with latency target $2 us.
+set_cgroup_v2() {
+	[ -e "$CGROOT/cgroup.controllers" ] || return
+	grep -qw io "$CGROOT/cgroup.controllers" || return
+	for g in $FG_GROUPS $BG_GROUPS; do
+		[ -d "$CGROOT/$g" ] && enable_io_to "$CGROOT/$g"
+	done
+	devno=$(cat "/sys/block/$1/dev")
+
+	for g in $FG_GROUPS; do
+		[ -e "$CGROOT/$g/io.latency" ] || continue
+		echo "$devno target=$2" >"$CGROOT/$g/io.latency" &&
+			log "$1: $g io.latency target=$2" && FG_DONE=1
+	done
+	# io.weight is used by io.cost, io.bfq.weight by BFQ.
+	for g in $BG_GROUPS; do
+		for f in io.weight io.bfq.weight; do
+			[ -e "$CGROOT/$g/$f" ] || continue
+			echo "$devno 10" >"$CGROOT/$g/$f" &&
+				log "$1: $g $f 10" && BG_DONE=1
+		done
+	done
+}
+
+set_blkio_v1() {
+	[ -d "$BLKIO" ] || return
+	for g in $FG_GROUPS; do
+		[ -e "$BLKIO/$g/blkio.bfq.weight" ] || continue
+		echo 1000 >"$BLKIO/$g/blkio.bfq.weight" &&
+			log "blkio $g bfq.weight 1000" && FG_DONE=1
+	done
+	for g in $BG_GROUPS; do
+		[ -e "$BLKIO/$g/blkio.bfq.weight" ] || continue
+		echo 10 >"$BLKIO/$g/blkio.bfq.weight" &&
+			log "blkio $g bfq.weight 10" && BG_DONE=1
+	done
+}
+
+apply() {
+	for d in $(disks); do
+		rot=$(cat "/sys/block/$d/queue/rotational")
+		if [ "$rot" = 1 ]; then
+			lat=$LAT_HDD_US
+			wbt=$WBT_HDD_US
+		else
+			lat=$LAT_SSD_US
+			wbt=$WBT_SSD_US
+		fi
+
+		set_sched "$d"
+		[ -w "/sys/block/$d/queue/wbt_lat_usec" ] &&
+			echo "$wbt" >"/sys/block/$d/queue/wbt_lat_usec"
+		set_cgroup_v2 "$d" "$lat"
+	done
+	set_blkio_v1
+
+	[ "$FG_DONE" = 1 ] || log "no foreground group found: $FG_GROUPS"
+	[ "$BG_DONE" = 1 ] || log "no background group found: $BG_GROUPS"
+	[ "$FG_DONE" = 1 ] || [ "$BG_DONE" = 1 ] ||
+		{ log "no cgroup configured, set FG_GROUPS/BG_GROUPS"; exit 1; }
+}
+
+case $1 in
+apply) apply ;;
+*) echo "usage: $(basename "$0") apply" >&2; exit 1 ;;
+esac
@@ -0,0 +1,78 @@
+#!/system/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# KSM for zygote-forked apps. Processes opt in themselves through
+# prctl(PR_SET_MEMORY_MERGE, 1) (6.4+), so only those are scanned.
+#
+#	ksm.sh daemon	start ksmd and follow memory pressure
+#	ksm.sh stat	merged pages per process and overall profit
+#
+# Per-process merged pages need 6.1+, the profit column 6.6+.
+#
+# The daemon uses smart scan (6.7+) and the scan-time advisor (6.8+) where
+# the kernel has them, and scales how much CPU ksmd may use with PSI
+# memory pressure: MIN_CPU when there is none, up to MAX_CPU at PSI_FULL.
+# Without the advisor it scales pages_to_scan the same way.
+
+KSM=/sys/kernel/mm/ksm
+INTERVAL=${INTERVAL:-10}	# seconds between adjustments
+PSI_FULL=${PSI_FULL:-20}	# some avg10 (%) at which ksmd gets MAX_CPU
+MIN_CPU=${MIN_CPU:-5}		# advisor_max_cpu (%) without pressure
+MAX_CPU=${MAX_CPU:-40}
+MIN_PAGES=${MIN_PAGES:-100}	# pages_to_scan range without the advisor
+MAX_PAGES=${MAX_PAGES:-2000}
+
+# Scale $1..$2 by the current memory pressure.
+scale() {
+	avg10=$(sed -n 's/^some avg10=\([0-9.]*\) .*/\1/p' /proc/pressure/memory)
+	awk -v lo="$1" -v hi="$2" -v p="$avg10" -v full="$PSI_FULL" 'BEGIN {
+		if (p > full) p = full
+		printf "%d\n", lo + (hi - lo) * p / full }'
+}
+
+daemon() {
+	[ -e "$KSM/run" ] || { echo "kernel lacks CONFIG_KSM" >&2; exit 1; }
+
+	[ -e "$KSM/smart_scan" ] && echo 1 >"$KSM/smart_scan"
+	advisor=0
+	if [ -e "$KSM/advisor_mode" ]; then
+		echo scan-time >"$KSM/advisor_mode" && advisor=1
+	fi
+	echo 1 >"$KSM/run"
+
+	while :; do
+		if [ -r /proc/pressure/memory ]; then
+			if [ "$advisor" = 1 ]; then
+				scale "$MIN_CPU" "$MAX_CPU" >"$KSM/advisor_max_cpu"
+			else
+				scale "$MIN_PAGES" "$MAX_PAGES" >"$KSM/pages_to_scan"
+			fi
+		fi
+		sleep "$INTERVAL"
+	done
+}
+
+report() {
+	printf '%8s %10s %12s  %s\n' PID MERGED_KB PROFIT_KB NAME
+	for f in /proc/[0-9]*/ksm_merging_pages; do
+		merged=$(cat "$f" 2>/dev/null)
+		[ "${merged:-0}" -gt 0 ] || continue
+		dir=${f%/*}
+		profit=$(awk '$1 == "ksm_process_profit" { print $2 }' \
+			"$dir/ksm_stat" 2>/dev/null)
+		printf '%8d %10d %12s  %s\n' "${dir#/proc/}" $((merged * 4)) \
+			"${profit:+$((profit / 1024))}" \
+			"$(tr '\0' ' ' <"$dir/cmdline" 2>/dev/null)"
+	done | sort -k2 -n -r
+
+	echo
+	for k in pages_shared pages_sharing full_scans general_profit; do
+		[ -r "$KSM/$k" ] && printf '%-16s %s\n' "$k:" "$(cat "$KSM/$k")"
+	done
+}
+
+case $1 in
+daemon) daemon ;;
+stat) report ;;
+*) echo "usage: $(basename "$0") daemon|stat" >&2; exit 1 ;;
+esac
@@ -0,0 +1,57 @@
+#!/system/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Multi-size THP (6.8+, serenade) for anonymous memory such as the ART
+# heap. With the small sizes set to "madvise", regions that ART marks with
+# MADV_HUGEPAGE fault in 16K-64K folios while the rest of the system stays
+# on 4K pages; MADV_COLLAPSE (6.1+) collapses a range right away instead
+# of waiting for khugepaged.
+#
+#	mthp.sh enable [mode [sizes]]	e.g. "mthp.sh enable madvise 16 32 64"
+#	mthp.sh stat			per-size fault allocation and fallback
+
+THP=/sys/kernel/mm/transparent_hugepage
+
+die() {
+	echo "mthp: $*" >&2
+	exit 1
+}
+
+enable() {
+	mode=${1:-madvise}
+	[ $# -gt 0 ] && shift
+	[ $# -gt 0 ] || set -- 16 32 64
+
+	ls -d "$THP"/hugepages-*kB >/dev/null 2>&1 ||
+		die "kernel has no multi-size THP"
+	for kb; do
+		f=$THP/hugepages-${kb}kB/enabled
+		[ -w "$f" ] || die "no ${kb}K THP size on this kernel"
+		echo "$mode" >"$f"
+	done
+}
+
+# Per-size counters are in hugepages-*/stats (6.9+).
+stat_sizes() {
+	ls -d "$THP"/hugepages-*kB >/dev/null 2>&1 ||
+		die "kernel has no multi-size THP"
+	printf '%-10s %-8s %12s %12s %6s\n' SIZE MODE ALLOC FALLBACK HIT
+	for d in "$THP"/hugepages-*kB; do
+		[ -r "$d/enabled" ] || continue
+		size=${d##*hugepages-}
+		mode=$(sed 's/.*\[\(.*\)\].*/\1/' "$d/enabled")
+		alloc=$(cat "$d/stats/anon_fault_alloc" 2>/dev/null)
+		fallback=$(cat "$d/stats/anon_fault_fallback" 2>/dev/null)
+		hit=-
+		[ $((${alloc:-0} + ${fallback:-0})) -gt 0 ] &&
+			hit=$((alloc * 100 / (alloc + fallback)))%
+		printf '%-10s %-8s %12s %12s %6s\n' "$size" "$mode" \
+			"${alloc:--}" "${fallback:--}" "$hit"
+	done | sort -n
+}
+
+case $1 in
+enable) shift; enable "$@" ;;
+stat) stat_sizes ;;
+*) echo "usage: $(basename "$0") enable [mode [sizes]] | stat" >&2; exit 1 ;;
+esac
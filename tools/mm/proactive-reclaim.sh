@@ -0,0 +1,128 @@
+#!/system/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Proactive reclaim for low-RAM Android-x86 devices.
+#
+# Turns MGLRU on and, while memory pressure is building but before lmkd
+# starts killing, pushes cold pages of each configured memcg out to zram
+# through memory.reclaim. Needs cgroup v2 with memory.reclaim (5.19+, or a
+# branch carrying the backport); MGLRU is used when the kernel has it.
+#
+# Targets are read from $CONF on every pass, one memcg per line, path
+# relative to the cgroup v2 root and target size in MiB:
+#
+#	apps/uid_10123	200
+#	system	400
+#
+# Progress is written to $STATS in /proc/meminfo style. KillsAverted counts
+# pressure episodes that ended without lmkd logging a kill.
+
+CGROOT=${CGROOT:-/sys/fs/cgroup}
+CONF=${CONF:-/data/system/proactive_reclaim.conf}
+STATS=${STATS:-/dev/proactive_reclaim.stat}
+INTERVAL=${INTERVAL:-5}		# seconds between passes
+PSI_LOW=${PSI_LOW:-2}		# some avg10 (%) that starts reclaim
+PSI_HIGH=${PSI_HIGH:-30}	# above this lmkd owns the situation
+STEP_MB=${STEP_MB:-32}		# most reclaimed from one memcg per pass
+
+passes=0
+reclaimed_kb=0
+episodes=0
+averted=0
+in_episode=0
+kills_at_start=0
+
+log() {
+	echo "proactive-reclaim: $*" >&2
+}
+
+psi_some_avg10() {
+	sed -n 's/^some avg10=\([0-9.]*\) .*/\1/p' /proc/pressure/memory
+}
+
+# lmkd logs one "killinfo" event per kill.
+lmkd_kills() {
+	logcat -b events -d -s killinfo 2>/dev/null | grep -c killinfo
+}
+
+above() {
+	awk -v a="$1" -v b="$2" 'BEGIN { exit !(a >= b) }'
+}
+
+# memory.current of memcg $1 in KiB. Byte counts above 2 GiB overflow
+# mksh's 32-bit arithmetic, so everything below works in KiB.
+current_kb() {
+	awk '{ printf "%d\n", $1 / 1024 }' "$1/memory.current"
+}
+
+# Reclaim $2 KiB from memcg $1. Where memory.reclaim takes a swappiness
+# argument (6.8+) anon pages are preferred, so they go to zram instead of
+# dropping file cache that apps will fault straight back in.
+reclaim() {
+	echo "${2}K$SWAPPINESS" >"$1/memory.reclaim" 2>/dev/null
+}
+
+write_stats() {
+	cat >"$STATS" <<EOF
+ProactivePasses:    $passes
+ProactiveReclaimed: $reclaimed_kb kB
+PressureEpisodes:   $episodes
+KillsAverted:       $averted
+EOF
+}
+
+reclaim_pass() {
+	[ -r "$CONF" ] || return
+	while read -r cg target_mb; do
+		case $cg in ''|'#'*) continue ;; esac
+		dir=$CGROOT/$cg
+		[ -r "$dir/memory.current" ] || continue
+
+		cur=$(current_kb "$dir")
+		excess=$((cur - target_mb * 1024))
+		[ "$excess" -gt 0 ] || continue
+		[ "$excess" -gt $((STEP_MB * 1024)) ] &&
+			excess=$((STEP_MB * 1024))
+
+		reclaim "$dir" "$excess"
+		now=$(current_kb "$dir")
+		[ "$now" -lt "$cur" ] &&
+			reclaimed_kb=$((reclaimed_kb + cur - now))
+	done <"$CONF"
+	passes=$((passes + 1))
+}
+
+[ -r /proc/pressure/memory ] || { log "kernel has no PSI"; exit 1; }
+[ -e "$CGROOT/cgroup.controllers" ] ||
+	{ log "no cgroup v2 hierarchy at $CGROOT"; exit 1; }
+
+# A zero-byte request only parses the arguments.
+SWAPPINESS=" swappiness=200"
+echo "0$SWAPPINESS" >"$CGROOT/memory.reclaim" 2>/dev/null || SWAPPINESS=
+
+if [ -w /sys/kernel/mm/lru_gen/enabled ]; then
+	echo y >/sys/kernel/mm/lru_gen/enabled
+else
+	log "no MGLRU, using the classic LRU"
+fi
+
+while :; do
+	avg10=$(psi_some_avg10)
+
+	if above "$avg10" "$PSI_LOW"; then
+		if [ "$in_episode" = 0 ]; then
+			in_episode=1
+			episodes=$((episodes + 1))
+			kills_at_start=$(lmkd_kills)
+		fi
+		above "$avg10" "$PSI_HIGH" || reclaim_pass
+	elif [ "$in_episode" = 1 ]; then
+		# Pressure went away again; count it if lmkd never had to act.
+		in_episode=0
+		[ "$(lmkd_kills)" -le "$kills_at_start" ] &&
+			averted=$((averted + 1))
+	fi
+
+	write_stats
+	sleep "$INTERVAL"
+done
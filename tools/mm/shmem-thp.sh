@@ -0,0 +1,40 @@
+#!/system/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Back large memfd/ashmem buffers (gralloc, Mesa) with transparent huge
+# pages. Both are shmem files, so the shmem THP policy covers them; with
+# "within_size" only buffers of at least one huge page get one, and when
+# no huge page can be allocated the kernel falls back to 4K pages.
+#
+#	shmem-thp.sh enable [within_size|advise|always]
+#	shmem-thp.sh stat
+
+THP=/sys/kernel/mm/transparent_hugepage
+
+vmstat() {
+	awk -v key="$1" '$1 == key { print $2; f = 1 } END { if (!f) print 0 }' \
+		/proc/vmstat
+}
+
+case $1 in
+enable)
+	[ -w "$THP/shmem_enabled" ] ||
+		{ echo "kernel lacks CONFIG_TRANSPARENT_HUGEPAGE" >&2; exit 1; }
+	echo "${2:-within_size}" >"$THP/shmem_enabled"
+	;;
+stat)
+	alloc=$(vmstat thp_file_alloc)
+	fallback=$(vmstat thp_file_fallback)
+	tries=$((alloc + fallback))
+	echo "ShmemHugeAlloc:    $alloc"
+	echo "ShmemHugeFallback: $fallback"
+	if [ "$tries" -gt 0 ]; then
+		echo "ShmemHugeHitRate:  $((alloc * 100 / tries))%"
+	fi
+	grep -E '^Shmem(Huge|PmdMapped)' /proc/meminfo
+	;;
+*)
+	echo "usage: $(basename "$0") enable [mode] | stat" >&2
+	exit 1
+	;;
+esac
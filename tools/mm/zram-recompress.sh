@@ -0,0 +1,100 @@
+#!/system/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Two-tier zram: swap out with a fast primary algorithm, then recompress
+# pages that stay idle with zstd, and optionally write idle huge
+# (incompressible) pages to a backing file in bounded batches.
+#
+#	zram-recompress.sh setup	before disksize is set / swapon
+#	zram-recompress.sh daemon	from a late-start service
+#
+# Needs CONFIG_ZRAM_MULTI_COMP (6.2+, crimson and serenade). The zstd
+# level is only applied where zram has algorithm_params (6.12+, serenade).
+# Idle ageing by time needs CONFIG_ZRAM_TRACK_ENTRY_ACTIME (6.8+) or
+# CONFIG_ZRAM_MEMORY_TRACKING (6.6, crimson); without either a page counts
+# as idle when it was not touched for one whole interval.
+# Writeback needs CONFIG_ZRAM_WRITEBACK and $BACKING_DEV.
+
+ZRAM=${ZRAM:-/sys/block/zram0}
+PRIMARY=${PRIMARY:-lz4}
+SECONDARY=${SECONDARY:-zstd}
+LEVEL=${LEVEL:-19}			# zstd level for recompression
+INTERVAL=${INTERVAL:-600}		# seconds between passes
+IDLE_AGE=${IDLE_AGE:-$INTERVAL}		# seconds untouched before recompressing
+BACKING_DEV=${BACKING_DEV:-}		# block device or loop for writeback
+WB_BATCH=${WB_BATCH:-2048}		# at most this many 4K pages per pass
+
+log() {
+	echo "zram-recompress: $*" >&2
+}
+
+setup() {
+	[ "$(cat "$ZRAM/disksize")" = 0 ] ||
+		{ log "$ZRAM is already initialised"; exit 1; }
+	[ -e "$ZRAM/recomp_algorithm" ] ||
+		{ log "kernel lacks CONFIG_ZRAM_MULTI_COMP"; exit 1; }
+
+	echo "$PRIMARY" >"$ZRAM/comp_algorithm"
+	echo "algo=$SECONDARY priority=1" >"$ZRAM/recomp_algorithm"
+	[ -e "$ZRAM/algorithm_params" ] &&
+		echo "priority=1 level=$LEVEL" >"$ZRAM/algorithm_params"
+
+	if [ -n "$BACKING_DEV" ]; then
+		if [ -e "$ZRAM/backing_dev" ]; then
+			echo "$BACKING_DEV" >"$ZRAM/backing_dev"
+		else
+			log "kernel lacks CONFIG_ZRAM_WRITEBACK, no writeback"
+		fi
+	fi
+}
+
+# With per-entry access times only pages older than IDLE_AGE are marked,
+# right before acting on them. Without, "all" is marked after a pass and
+# any access during the following interval clears the flag again, so the
+# next pass only sees pages that stayed untouched for the whole interval.
+AGE_IDLE=0
+
+mark_idle() {
+	if [ "$AGE_IDLE" = 1 ]; then
+		echo "$IDLE_AGE" >"$ZRAM/idle"
+	fi
+}
+
+mark_all() {
+	[ "$AGE_IDLE" = 1 ] || echo all >"$ZRAM/idle"
+}
+
+writeback() {
+	[ -n "$BACKING_DEV" ] && [ -e "$ZRAM/writeback" ] || return
+
+	# The limit is consumed by the kernel as pages are written, so this
+	# caps every pass at WB_BATCH pages.
+	echo 1 >"$ZRAM/writeback_limit_enable"
+	echo "$WB_BATCH" >"$ZRAM/writeback_limit"
+	echo huge_idle >"$ZRAM/writeback" 2>/dev/null
+}
+
+daemon() {
+	[ -e "$ZRAM/recompress" ] ||
+		{ log "kernel lacks CONFIG_ZRAM_MULTI_COMP"; exit 1; }
+
+	echo "$IDLE_AGE" >"$ZRAM/idle" 2>/dev/null && AGE_IDLE=1
+	[ "$AGE_IDLE" = 1 ] ||
+		log "no per-entry access times, idle means untouched for ${INTERVAL}s"
+
+	mark_all
+	while :; do
+		sleep "$INTERVAL"
+		mark_idle
+		writeback
+		echo "type=idle" >"$ZRAM/recompress" 2>/dev/null
+		mark_all
+		log "$(cat "$ZRAM/mm_stat")"
+	done
+}
+
+case $1 in
+setup) setup ;;
+daemon) daemon ;;
+*) echo "usage: $(basename "$0") setup|daemon" >&2; exit 1 ;;
+esac
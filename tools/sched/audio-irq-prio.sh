@@ -0,0 +1,49 @@
+#!/system/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Raise the threaded interrupt handlers of sound devices above the other
+# IRQ threads, which all run at SCHED_FIFO 50 by default.
+#
+#	audio-irq-prio.sh [priority]
+#
+# Sound IRQs are only threaded when the kernel is booted with
+# "threadirqs" (CONFIG_IRQ_FORCED_THREADING) or runs PREEMPT_RT. Pairs
+# with "preempt=full" on PREEMPT_DYNAMIC kernels (5.12+). Run it after
+# the sound drivers are bound, e.g. on sys.boot_completed.
+
+PRIO=${1:-80}
+PATTERN=${PATTERN:-snd|sof|hda|azx|audio}
+
+# Android's chrt is toybox ("chrt -f -p PID PRIO"); util-linux, as on a
+# desktop userspace, wants "chrt -f -p PRIO PID".
+set_fifo() {
+	if chrt --version 2>/dev/null | grep -q util-linux; then
+		chrt -f -p "$PRIO" "$1"
+	else
+		chrt -f -p "$1" "$PRIO"
+	fi
+}
+
+found=0
+failed=0
+for comm in /proc/[0-9]*/comm; do
+	name=$(cat "$comm" 2>/dev/null) || continue
+	case $name in irq/*) ;; *) continue ;; esac
+	echo "$name" | grep -qiE "$PATTERN" || continue
+
+	pid=${comm#/proc/}
+	pid=${pid%/comm}
+	found=$((found + 1))
+	if set_fifo "$pid"; then
+		echo "$name ($pid): SCHED_FIFO $PRIO"
+	else
+		echo "audio-irq-prio: could not set $name ($pid) to FIFO $PRIO" >&2
+		failed=$((failed + 1))
+	fi
+done
+
+if [ "$found" = 0 ]; then
+	echo "audio-irq-prio: no threaded sound IRQs (boot with threadirqs?)" >&2
+	exit 1
+fi
+[ "$failed" = 0 ]
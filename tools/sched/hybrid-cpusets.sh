@@ -0,0 +1,88 @@
+#!/system/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Android cpusets for hybrid Intel CPUs (Alder Lake and later): keep
+# top-app and foreground on every CPU with ITMT on, so the scheduler
+# prefers the P-cores for them, and pack background work onto the E-cores.
+#
+#	hybrid-cpusets.sh apply
+#	hybrid-cpusets.sh stat [seconds]	where each cpuset's tasks ran
+#
+# P- and E-cores are read from the hybrid PMU (cpu_core/cpu_atom, 5.13+).
+# Run "apply" after init has set up /dev/cpuset, e.g. on
+# sys.boot_completed, as init.rc writes the cpusets too.
+
+CPUSET=${CPUSET:-/dev/cpuset}
+PCORES=$(cat /sys/devices/cpu_core/cpus 2>/dev/null)
+ECORES=$(cat /sys/devices/cpu_atom/cpus 2>/dev/null)
+ALL=$(cat /sys/devices/system/cpu/online)
+SETS="top-app foreground background system-background restricted"
+
+die() {
+	echo "hybrid-cpusets: $*" >&2
+	exit 1
+}
+
+apply() {
+	[ -n "$PCORES" ] && [ -n "$ECORES" ] || die "not a hybrid CPU"
+
+	[ -w /proc/sys/kernel/sched_itmt_enabled ] &&
+		echo 1 >/proc/sys/kernel/sched_itmt_enabled
+
+	for set in $SETS; do
+		[ -d "$CPUSET/$set" ] || continue
+		case $set in
+		top-app|foreground) echo "$ALL" >"$CPUSET/$set/cpus" ;;
+		*) echo "$ECORES" >"$CPUSET/$set/cpus" ;;
+		esac
+	done
+}
+
+# Sample the CPU every task of each cpuset last ran on (field 39 of
+# /proc/<tid>/stat) once a second and print the share on P-cores.
+report() {
+	[ -n "$PCORES" ] || die "not a hybrid CPU"
+	secs=${1:-10}
+	samples=$(mktemp) || exit 1
+
+	i=0
+	while [ "$i" -lt "$secs" ]; do
+		for set in $SETS; do
+			[ -r "$CPUSET/$set/tasks" ] || continue
+			sed "s|.*|/proc/&/stat|" "$CPUSET/$set/tasks" |
+				xargs cat 2>/dev/null | sed 's/.*) //' |
+				awk -v set="$set" '{ print set, $37 }'
+		done
+		i=$((i + 1))
+		sleep 1
+	done >"$samples"
+
+	printf '%-20s %8s %8s %6s\n' CPUSET P E P%
+	awk -v pcores="$PCORES" -v sets="$SETS" '
+		BEGIN {
+			n = split(pcores, r, ",")
+			for (i = 1; i <= n; i++) {
+				m = split(r[i], b, "-")
+				for (c = b[1]; c <= (m > 1 ? b[2] : b[1]); c++)
+					isp[c] = 1
+			}
+		}
+		{ if ($2 in isp) p[$1]++; else e[$1]++ }
+		END {
+			n = split(sets, s, " ")
+			for (i = 1; i <= n; i++) {
+				t = p[s[i]] + e[s[i]]
+				if (!t)
+					continue
+				printf "%-20s %8d %8d %5d%%\n", s[i], p[s[i]],
+					e[s[i]], p[s[i]] * 100 / t
+			}
+		}' "$samples"
+	rm -f "$samples"
+}
+
+case $1 in
+apply) apply ;;
+stat) report "$2" ;;
+*) echo "usage: $(basename "$0") apply | stat [seconds]" >&2; exit 1 ;;
+esac
@@ -0,0 +1,87 @@
+#!/system/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Per-uid CPU bandwidth and uclamp on the cgroup v2 hierarchy Android
+# already keeps per app (uid_<uid>/pid_<pid>, at the root or under apps/
+# and system/ depending on the release). Changing one uid's limits
+# is a single write to its uid_<uid> group, whatever the number of tasks,
+# instead of moving every pid into a cpuctl group.
+#
+#	uid-cpu.sh enable
+#	uid-cpu.sh set <uid> [max=<quota>|max[/<period>]]
+#			     [uclamp.min=<pct>] [uclamp.max=<pct>] [weight=<n>]
+#	uid-cpu.sh show <uid>
+#
+# The cpu controller can sit in only one hierarchy, so the v1 cpuctl
+# mount has to be dropped from cgroups.json first. cpu.uclamp.* needs
+# CONFIG_UCLAMP_TASK_GROUP and cpu.max CONFIG_CFS_BANDWIDTH.
+
+CGROOT=${CGROOT:-/sys/fs/cgroup}
+
+die() {
+	echo "uid-cpu: $*" >&2
+	exit 1
+}
+
+# Enable cpu in subtree_control of every level from the root down to the
+# parent of group $1.
+enable_to() {
+	local parent=${1%/*}
+	[ "$parent" = "$CGROOT" ] || enable_to "$parent"
+	grep -qw cpu "$parent/cgroup.subtree_control" ||
+		echo +cpu >"$parent/cgroup.subtree_control" ||
+		die "cannot enable cpu in $parent"
+}
+
+uid_groups() {
+	find "$CGROOT" -maxdepth 3 -type d -name "uid_${1:-*}" 2>/dev/null
+}
+
+enable() {
+	grep -qw cpu "$CGROOT/cgroup.controllers" ||
+		die "cpu controller not available on $CGROOT (still on v1 cpuctl?)"
+	echo +cpu >"$CGROOT/cgroup.subtree_control"
+	for parent in $(uid_groups | sed 's|/[^/]*$||' | sort -u); do
+		[ "$parent" = "$CGROOT" ] || enable_to "$parent/uid_"
+	done
+}
+
+uid_dir() {
+	dir=$(uid_groups "$1" | head -n 1)
+	[ -n "$dir" ] || die "no cgroup for uid $1"
+	[ -e "$dir/cpu.weight" ] || enable_to "$dir"
+	[ -e "$dir/cpu.weight" ] || die "cpu controller not enabled, run enable"
+	echo "$dir"
+}
+
+set_limits() {
+	dir=$(uid_dir "$1") || exit 1
+	shift
+	for arg; do
+		key=${arg%%=*}
+		val=${arg#*=}
+		case $key in
+		max)
+			echo "$val" | tr / ' ' >"$dir/cpu.max" ;;
+		uclamp.min|uclamp.max|weight)
+			echo "$val" >"$dir/cpu.$key" ;;
+		*)
+			die "unknown setting $arg" ;;
+		esac || die "cannot set $arg"
+	done
+}
+
+show() {
+	dir=$(uid_dir "$1") || exit 1
+	for f in cpu.max cpu.weight cpu.uclamp.min cpu.uclamp.max; do
+		[ -r "$dir/$f" ] && printf '%-15s %s\n' "$f:" "$(cat "$dir/$f")"
+	done
+	grep -E '^(usage_usec|nr_throttled|throttled_usec)' "$dir/cpu.stat"
+}
+
+case $1 in
+enable) enable ;;
+set) [ $# -ge 3 ] || die "usage: set <uid> <key>=<value>..."; shift; set_limits "$@" ;;
+show) [ $# -eq 2 ] || die "usage: show <uid>"; show "$2" ;;
+*) echo "usage: $(basename "$0") enable | set <uid> <key>=<value>... | show <uid>" >&2; exit 1 ;;
+esac